@@ -8,15 +8,105 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <string.h>
 #include <cctype>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 const int krows = 10;
 const int kcols = 10;
 const int chestAmounts = 5;
-int** userBoard = new int*[krows];
-int** aiBoard = new int*[krows];
-int userChestsFound[5] = {0}; // Tracks the number of pieces found for each chest type
-int aiChestsFound[5] = {0};   // Same for AI
+const int kCells = krows * kcols;
+
+/*
+ * State of every player in an N-player game, stored as a structure of arrays so that per-player checks run over contiguous data.
+ * Player p's board is cells[p * kCells ... (p + 1) * kCells), reachable as an int** through &rows[p * krows].
+ * chestsFound[p * chestAmounts ...] counts the pieces dug up from player p's board for each chest type.
+ * A player is eliminated once chestCellsLeft[p] reaches 0.
+ */
+struct PlayerStates {
+  int count;
+  int humans;
+  int *cells;
+  int **rows;
+  int *chestsFound;
+  int *chestCellsLeft;
+  bool *isHuman;
+};
+
+// Outcomes reported by resolveDig()
+const int kDigRepeat = -1;
+const int kDigMiss = 0;
+const int kDigHit = 1;
+const int kDigChestComplete = 2;
+
+// Opening book: file magic ("THOB" little-endian) and deepest book the generator will build
+const unsigned int kBookMagic = 0x424F4854;
+const int kBookMaxDepth = 20;
+
+/*
+ * Opening book key: one bit per cell for "dug" and one for "held treasure", enough for boards of up to 128 cells.
+ */
+struct BookKey {
+  unsigned long long dug[2];
+  unsigned long long hit[2];
+};
+
+/*
+ * A book position and its best dig, used while generating the book.
+ */
+struct BookEntry {
+  BookKey key;
+  unsigned char move;
+};
+
+/*
+ * Opening book mapped read-only from disk: sorted keys followed by one move (cell index) per key.
+ */
+struct OpeningBook {
+  void *data;
+  size_t size;
+  int count;
+  const BookKey *keys;
+  const unsigned char *moves;
+};
+
+// Trajectory export: rows per chunk and columns per chunk
+const int kExportChunkRows = 1 << 16;
+const int kExportColumns = 8;
+
+/*
+ * One chunk of exported turns, stored column by column.
+ * boardState holds kCells characters per row, as show() would render the target board before the dig.
+ */
+struct TrajectoryChunk {
+  int rows;
+  unsigned int *gameId;
+  unsigned char *player;
+  unsigned short *turn;
+  char *boardState;
+  unsigned char *digRow;
+  unsigned char *digCol;
+  unsigned char *hit;
+  unsigned char *outcome;
+};
+
+/*
+ * Double-buffered trajectory writer: the simulation fills one chunk while a background thread writes the other.
+ */
+struct TrajectoryWriter {
+  FILE *file;
+  bool compress;
+  bool failed;
+  int active;
+  TrajectoryChunk chunks[2];
+  unsigned char *scratch;
+  char *delta;
+  std::thread flusher;
+};
 
 /*
  * Attempts to place a treasure chest on a specified board with the given orientation and starting position.
@@ -71,6 +161,22 @@ bool placeChest(int **array, int offsetRow, int offsetCol, int x, int rowOrCol){
   return true;
 }
 
+/*
+ * Converts a single board cell into the character shown to the opponent, hiding any chest that has not been dug up yet.
+ *
+ * @param cell Value stored in the board cell.
+ * @return '-' for an undug cell, 'X' for a dug cell with no treasure, '@' for a dug cell with treasure.
+ */
+char showCell(int cell){
+  if(cell == -1){
+    return 'X';
+  }
+  else if(cell < 0){
+    return '@';
+  }
+  return '-';
+}
+
 /*
  * Displays the game board to the user, where each cell is represented by a specific character.
  * Empty cells are shown as '-', dug cells with no treasure as 'X', and cells where treasure was found are shown as '@'.
@@ -83,18 +189,7 @@ bool placeChest(int **array, int offsetRow, int offsetCol, int x, int rowOrCol){
 int show(int **board, const int row, const int col){
   for(int i = 0; i < row; i++){
     for(int j = 0; j < col; j++){
-      if(board[i][j] == 0){
-        printf("%5c", '-');
-      }
-      else if(board[i][j] == -1){
-        printf("%5c", 'X');
-      }
-      else if(board[i][j] < 0){
-        printf("%5c", '@');
-      }
-      else{
-        printf("%5c", '-');
-      }
+      printf("%5c", showCell(board[i][j]));
     }
     printf("\n");
   }
@@ -159,6 +254,38 @@ int reveal(int **board, const int row, const int col){
   return 0;
 }
 
+/*
+ * Resolves a dig at the specified location without printing anything, so simulations can reuse the game rules.
+ * Updates the cell and the chest progress exactly like dig() does.
+ *
+ * @param board Game board array.
+ * @param targetRow Row index where the dig action is attempted.
+ * @param targetCol Column index where the dig action is attempted.
+ * @param chestsFound Array tracking the number of pieces found for each type of chest.
+ * @return kDigRepeat if the cell was already dug, kDigMiss, kDigHit, or kDigChestComplete if the hit finished a chest.
+ */
+int resolveDig(int **board, int targetRow, int targetCol, int *chestsFound){
+  int cell = board[targetRow][targetCol];
+
+  if(cell > 0){
+    int chestIndex = cell - 11; // Convert chest code to index
+    int chestSize = 16 - cell; // Calculate size of the chest correctly
+
+    // Mark as dug and update found chests
+    board[targetRow][targetCol] = -cell;
+    chestsFound[chestIndex]++;
+    if(chestsFound[chestIndex] == chestSize){
+      return kDigChestComplete;
+    }
+    return kDigHit;
+  }
+  else if(cell == 0){
+    board[targetRow][targetCol] = -1;
+    return kDigMiss;
+  }
+  return kDigRepeat;
+}
+
 /*
  * Executes a digging action at the specified location on the game board.
  * Updates the cell based on whether a treasure was found and tracks the progress of treasure discovery.
@@ -170,34 +297,159 @@ int reveal(int **board, const int row, const int col){
  * @return 0 if the action was processed, even if nothing was found or the cell was already dug.
  */
 int dig(int **board, int targetRow, int targetCol, int *chestsFound){
-  
-  if (board[targetRow][targetCol] == -1) {
+  int chestCode = board[targetRow][targetCol];
+
+  if (chestCode == -1) {
       printf("You've already dug here!\n");
       return 0;
   }
 
-  if(board[targetRow][targetCol] > 0){
-      int chestCode = board[targetRow][targetCol];
-      int chestIndex = chestCode - 11; // Convert chest code to index
-      int chestSize = 16 - chestCode; // Calculate size of the chest correctly
-    
-      // Mark as dug
-      board[targetRow][targetCol] = -chestCode;
-      // Update found chests
-      chestsFound[chestIndex]++;
+  // Check if the whole chest is dug up
+  if(resolveDig(board, targetRow, targetCol, chestsFound) == kDigChestComplete){
+      printf("All parts of a %d-sized chest have been dug up!\n", 16 - chestCode);
+  }
+
+  return 0;
+}
+
+/*
+ * Resolves a block of gathered cell values with branch-free mask arithmetic, so the loop vectorises.
+ * Each value is replaced by what the cell becomes after being dug: a chest code c becomes -c, an empty cell becomes -1,
+ * and an already dug cell is left unchanged.
+ *
+ * @param cells Gathered cell values, updated in place.
+ * @param results Receives kDigHit, kDigMiss or kDigRepeat for each cell (chest completions are marked afterwards).
+ * @param count Number of cells in the block.
+ */
+void resolveDigMask(int *cells, signed char *results, int count){
+  for(int k = 0; k < count; k++){
+    int cell = cells[k];
+    int hit = (cell > 0);
+    int miss = (cell == 0);
+    // kDigHit = 1, kDigMiss = 0, kDigRepeat = -1
+    results[k] = (signed char)(hit - (cell < 0));
+    cells[k] = cell - 2 * cell * hit - miss;
+  }
+}
 
-      // Check if the whole chest is dug up
-      if(chestsFound[chestIndex] == chestSize){
-          printf("All parts of a %d-sized chest have been dug up!\n", chestSize);
+/*
+ * Updates chest progress for a resolved block and upgrades the dig that finished a chest to kDigChestComplete,
+ * matching what calling resolveDig() on each cell in order would report.
+ *
+ * @param cells Resolved cell values from resolveDigMask().
+ * @param results Results from resolveDigMask(), updated in place.
+ * @param count Number of cells in the block.
+ * @param chestsFound Array tracking the number of pieces found for each type of chest.
+ * @return Number of hits in the block.
+ */
+int countChestHits(const int *cells, signed char *results, int count, int *chestsFound){
+  int hitsPerChest[5] = {0};
+  int hits = 0;
+
+  for(int k = 0; k < count; k++){
+    if(results[k] == kDigHit){
+      hitsPerChest[-cells[k] - 11]++;
+      hits++;
+    }
+  }
+
+  for(int i = 0; i < chestAmounts; i++){
+    int chestSize = 5 - i;
+    int before = chestsFound[i];
+    chestsFound[i] += hitsPerChest[i];
+    if(before >= chestSize || chestsFound[i] < chestSize){
+      continue;
+    }
+    // The (chestSize - before)-th hit on this chest in dig order is the one that completes it
+    int needed = chestSize - before;
+    for(int k = 0; k < count; k++){
+      if(results[k] == kDigHit && -cells[k] - 11 == i && --needed == 0){
+        results[k] = kDigChestComplete;
+        break;
       }
-    } 
-    else if (board[targetRow][targetCol] == 0) {
-      board[targetRow][targetCol] = -1;
     }
-  
-    return 0;
+  }
+  return hits;
 }
 
+/*
+ * Resolves a list of digs in one call without printing. The outcome is the same as calling resolveDig() on each
+ * location in order, including repeated locations within the list, but cells are processed in blocks through resolveDigMask().
+ *
+ * @param board Game board array.
+ * @param digRows Row index of each dig.
+ * @param digCols Column index of each dig.
+ * @param count Number of digs.
+ * @param chestsFound Array tracking the number of pieces found for each type of chest.
+ * @param results Receives one kDig* outcome per dig.
+ * @return Number of digs that hit treasure.
+ */
+int digBatch(int **board, const int *digRows, const int *digCols, int count, int *chestsFound, signed char *results){
+  int cells[kCells];
+  bool seen[kCells];
+  int hits = 0;
+
+  for(int start = 0; start < count; start += kCells){
+    int blockSize = (count - start < kCells) ? (count - start) : kCells;
+    memset(seen, 0, sizeof(seen));
+
+    // Gather; a location repeated within the block behaves as already dug
+    for(int k = 0; k < blockSize; k++){
+      int row = digRows[start + k];
+      int col = digCols[start + k];
+      int index = row * kcols + col;
+      cells[k] = seen[index] ? -1 : board[row][col];
+      seen[index] = true;
+    }
+
+    resolveDigMask(cells, results + start, blockSize);
+    hits += countChestHits(cells, results + start, blockSize, chestsFound);
+
+    // Scatter back only the cells that changed
+    for(int k = 0; k < blockSize; k++){
+      if(results[start + k] != kDigRepeat){
+        board[digRows[start + k]][digCols[start + k]] = cells[k];
+      }
+    }
+  }
+  return hits;
+}
+
+/*
+ * Sonar power-up: digs every cell of a rectangular area in one call without printing. The area is clipped to the board.
+ *
+ * @param board Game board array.
+ * @param top Row index of the top-left corner.
+ * @param left Column index of the top-left corner.
+ * @param height Number of rows to scan.
+ * @param width Number of columns to scan.
+ * @param chestsFound Array tracking the number of pieces found for each type of chest.
+ * @param results Receives one kDig* outcome per scanned cell, row by row; needs room for height * width entries.
+ * @return Number of cells scanned after clipping.
+ */
+int sonarScan(int **board, int top, int left, int height, int width, int *chestsFound, signed char *results){
+  int cells[kCells];
+  int bottom = (top + height < krows) ? (top + height) : krows;
+  int right = (left + width < kcols) ? (left + width) : kcols;
+  top = (top > 0) ? top : 0;
+  left = (left > 0) ? left : 0;
+  if(top >= bottom || left >= right){
+    return 0;
+  }
+  int span = right - left;
+  int count = (bottom - top) * span;
+
+  for(int i = top; i < bottom; i++){
+    memcpy(&cells[(i - top) * span], &board[i][left], span * sizeof(int));
+  }
+  resolveDigMask(cells, results, count);
+  countChestHits(cells, results, count, chestsFound);
+  // Dug cells keep their value, so whole rows can be copied back
+  for(int i = top; i < bottom; i++){
+    memcpy(&board[i][left], &cells[(i - top) * span], span * sizeof(int));
+  }
+  return count;
+}
 
 /*
  * Initializes the game board, setting all cells to indicate they are empty.
@@ -241,8 +493,10 @@ bool placeChestChecker(int **board, int rowLocation, int colLocation, int chestT
 /*
  * Handles user input for placing chests on the user's game board. It prompts the user for chest type, orientation, and coordinates.
  * Validates the input and retries if the input is incorrect or if the placement fails.
+ *
+ * @param board Pointer to the user's game board array.
  */
-void userInput(){
+void userInput(int **board){
   int chestType = 0;
   int rowLocation = 0;
   int colLocation = 0;
@@ -290,119 +544,890 @@ void userInput(){
     printf("\n");
   }
 
-  if(!placeChestChecker(userBoard, rowLocation, colLocation, chestType, horiVert)){
+  if(!placeChestChecker(board, rowLocation, colLocation, chestType, horiVert)){
     printf("Failed to place chest. Check to see if you have entered valid values! \n");
-    userInput();
+    userInput(board);
   }
 }
 
 /*
- * Automatically generates input for placing chests on the AI's game board. It randomly selects chest types, orientations, and coordinates until a valid placement is achieved.
+ * Automatically generates input for placing chests on an AI's game board. It randomly selects chest types, orientations, and coordinates until a valid placement is achieved.
+ * The random generator is seeded once in main(), so AIs placing in the same second still get different boards.
+ *
+ * @param board Pointer to the AI's game board array.
  */
-void aiInput(){
-  srand(time(NULL));
+void aiInput(int **board){
   int chestType = ((rand() % 5) + 11);
   int rowLocation = (rand() % krows);
   int colLocation = (rand() % kcols);
   int horiVert = (rand() % 2);
 
   // Retry loop until successful placement
-  while(!placeChestChecker(aiBoard, rowLocation, colLocation, chestType, horiVert)){
+  while(!placeChestChecker(board, rowLocation, colLocation, chestType, horiVert)){
     rowLocation = rand() % krows;
     colLocation = rand() % kcols;
   }
 }
 
 /*
- * Checks if all chests on a given board have been found, which would indicate the end of the game.
+ * Counts the cells on a board that still hide treasure.
  *
  * @param board The game board to check for remaining treasures.
- * @return True if no chests remain unexposed, otherwise false.
+ * @return Number of chest cells that have not been dug up yet.
  */
-bool gameEnd(int **board){
+int countChestCells(int **board){
+  int count = 0;
   for(int i = 0; i < krows; i++){
     for(int j = 0; j < kcols; j++){
-      if(board[i][j] > 0){
-        return false;
+      count += (board[i][j] > 0);
+    }
+  }
+  return count;
+}
+
+/*
+ * Allocates the state of every player with empty boards. The first players are human, the rest are AI.
+ *
+ * @param players State to allocate.
+ * @param count Total number of players.
+ * @param humans Number of human players.
+ */
+void allocatePlayers(PlayerStates *players, int count, int humans){
+  players->count = count;
+  players->humans = humans;
+  players->cells = new int[count * kCells];
+  players->rows = new int*[count * krows];
+  players->chestsFound = new int[count * chestAmounts];
+  players->chestCellsLeft = new int[count];
+  players->isHuman = new bool[count];
+
+  for(int p = 0; p < count; p++){
+    for(int i = 0; i < krows; i++){
+      players->rows[p * krows + i] = &players->cells[p * kCells + i * kcols];
+    }
+    initializeBoard(&players->rows[p * krows], krows, kcols);
+    players->chestCellsLeft[p] = 0;
+    players->isHuman[p] = (p < humans);
+  }
+  memset(players->chestsFound, 0, count * chestAmounts * sizeof(int));
+}
+
+/*
+ * Properly deallocates all dynamic memory used for the players' boards to avoid memory leaks. This function should be called before the program exits.
+ *
+ * @param players State to release.
+ */
+void freePlayers(PlayerStates *players){
+  delete[] players->cells;
+  delete[] players->rows;
+  delete[] players->chestsFound;
+  delete[] players->chestCellsLeft;
+  delete[] players->isHuman;
+}
+
+/*
+ * Counts the players that still have treasure left on their board.
+ *
+ * @param players State of every player.
+ * @return Number of players not yet eliminated.
+ */
+int countPlayersLeft(const PlayerStates *players){
+  int left = 0;
+  for(int p = 0; p < players->count; p++){
+    left += (players->chestCellsLeft[p] > 0);
+  }
+  return left;
+}
+
+/*
+ * Digs at a location on a player's board and keeps track of the treasure left on it.
+ *
+ * @param players State of every player.
+ * @param target Player whose board is dug.
+ * @param digRow Row index of the dig.
+ * @param digCol Column index of the dig.
+ * @param announce Whether to go through dig() and print its messages, or resolve silently.
+ * @return True if this dig found the last treasure on the board and eliminated the target.
+ */
+bool digOpponent(PlayerStates *players, int target, int digRow, int digCol, bool announce){
+  int **board = &players->rows[target * krows];
+  int *chestsFound = &players->chestsFound[target * chestAmounts];
+  bool hit = (board[digRow][digCol] > 0);
+
+  if(announce){
+    dig(board, digRow, digCol, chestsFound);
+  }
+  else{
+    resolveDig(board, digRow, digCol, chestsFound);
+  }
+  return hit && --players->chestCellsLeft[target] == 0;
+}
+
+/*
+ * Picks a random opponent that has not been eliminated yet.
+ *
+ * @param players State of every player.
+ * @param self The player choosing an opponent.
+ * @return Index of the chosen opponent.
+ */
+int chooseAiTarget(const PlayerStates *players, int self){
+  int target = rand() % players->count;
+  while(target == self || players->chestCellsLeft[target] == 0){
+    target = (target + 1) % players->count;
+  }
+  return target;
+}
+
+/*
+ * Computes the AI's best next dig on a board from what the opponent can see: dug misses, dug treasure and undug cells.
+ * Every position where a chest of each size could still lie (not covering a known miss) adds weight to the undug cells it covers,
+ * and positions that run through already found treasure weigh much more, so the AI follows up on hits.
+ *
+ * @param board Game board array; hidden chests are ignored.
+ * @return Index (row * kcols + col) of the undug cell with the highest weight, lowest index on ties, or -1 if every cell is dug.
+ */
+int bestDig(int **board){
+  int weights[kCells] = {0};
+
+  for(int i = 0; i < chestAmounts; i++){
+    int chestSize = 5 - i;
+    for(int rowOrCol = 0; rowOrCol < 2; rowOrCol++){
+      int rowStep = rowOrCol;
+      int colStep = 1 - rowOrCol;
+      for(int r = 0; r + rowStep * (chestSize - 1) < krows; r++){
+        for(int c = 0; c + colStep * (chestSize - 1) < kcols; c++){
+          int hitsCovered = 0;
+          bool blocked = false;
+          for(int k = 0; k < chestSize && !blocked; k++){
+            int cell = board[r + k * rowStep][c + k * colStep];
+            blocked = (cell == -1);
+            hitsCovered += (cell < -1);
+          }
+          if(blocked){
+            continue;
+          }
+          int weight = 1 + 20 * hitsCovered;
+          for(int k = 0; k < chestSize; k++){
+            weights[(r + k * rowStep) * kcols + (c + k * colStep)] += weight;
+          }
+        }
       }
     }
   }
+
+  int best = -1;
+  for(int cell = 0; cell < kCells; cell++){
+    if(board[cell / kcols][cell % kcols] >= 0 && (best < 0 || weights[cell] > weights[best])){
+      best = cell;
+    }
+  }
+  return best;
+}
+
+/*
+ * Builds the opening book key of a board: which cells have been dug and which of those held treasure, one bit per cell.
+ *
+ * @param board Game board array.
+ * @param key Receives the key.
+ */
+void makeBookKey(int **board, BookKey *key){
+  memset(key, 0, sizeof(BookKey));
+  for(int cell = 0; cell < kCells; cell++){
+    int value = board[cell / kcols][cell % kcols];
+    unsigned long long bit = 1ULL << (cell % 64);
+    if(value < 0){
+      key->dug[cell / 64] |= bit;
+    }
+    if(value < -1){
+      key->hit[cell / 64] |= bit;
+    }
+  }
+}
+
+/*
+ * Orders opening book keys word by word, as used for sorting the book and searching it.
+ *
+ * @param a First key.
+ * @param b Second key.
+ * @return Negative, zero or positive like memcmp.
+ */
+int compareBookKeys(const BookKey *a, const BookKey *b){
+  unsigned long long x[4] = {a->dug[0], a->dug[1], a->hit[0], a->hit[1]};
+  unsigned long long y[4] = {b->dug[0], b->dug[1], b->hit[0], b->hit[1]};
+  for(int i = 0; i < 4; i++){
+    if(x[i] != y[i]){
+      return (x[i] < y[i]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * qsort() comparator for book entries.
+ */
+int compareBookEntries(const void *a, const void *b){
+  return compareBookKeys(&((const BookEntry*)a)->key, &((const BookEntry*)b)->key);
+}
+
+/*
+ * Walks every hit/miss outcome of the AI's own digs up to the given depth and records the best dig at each step.
+ *
+ * @param board Scratch board holding the dig history so far (-1 for a miss, -11 for a hit, 0 for undug).
+ * @param depth Number of digs still to explore.
+ * @param entries Receives the book entries.
+ * @param count Number of entries recorded so far, updated in place.
+ */
+void generateBookEntries(int **board, int depth, BookEntry *entries, int *count){
+  if(depth == 0){
+    return;
+  }
+  int cell = bestDig(board);
+  if(cell < 0){
+    return;
+  }
+  makeBookKey(board, &entries[*count].key);
+  entries[*count].move = (unsigned char)cell;
+  (*count)++;
+
+  int *target = &board[cell / kcols][cell % kcols];
+  *target = -1;
+  generateBookEntries(board, depth - 1, entries, count);
+  *target = -11;
+  generateBookEntries(board, depth - 1, entries, count);
+  *target = 0;
+}
+
+/*
+ * Offline generator: writes the opening book for the standard board up to the given depth.
+ * The file holds a header {magic "THOB", version, rows, columns, chests, depth, entries, 0}, the sorted keys, then one move byte per key.
+ *
+ * @param path Output file path.
+ * @param depth Number of AI digs covered by the book (1 to kBookMaxDepth).
+ * @return True if the book was written successfully.
+ */
+bool generateOpeningBook(const char *path, int depth){
+  if(depth < 1 || depth > kBookMaxDepth){
+    printf("The book depth should be between 1 and %d!\n", kBookMaxDepth);
+    return false;
+  }
+
+  int cells[kCells] = {0};
+  int *board[krows];
+  for(int i = 0; i < krows; i++){
+    board[i] = &cells[i * kcols];
+  }
+  BookEntry *entries = new BookEntry[(1 << depth) - 1];
+  int count = 0;
+  generateBookEntries(board, depth, entries, &count);
+  qsort(entries, count, sizeof(BookEntry), compareBookEntries);
+
+  FILE *file = fopen(path, "wb");
+  bool ok = (file != NULL);
+  if(ok){
+    unsigned int header[8] = {kBookMagic, 1, krows, kcols, chestAmounts, (unsigned int)depth, (unsigned int)count, 0};
+    ok = fwrite(header, sizeof(header), 1, file) == 1;
+    for(int i = 0; i < count && ok; i++){
+      ok = fwrite(&entries[i].key, sizeof(BookKey), 1, file) == 1;
+    }
+    for(int i = 0; i < count && ok; i++){
+      ok = fputc(entries[i].move, file) != EOF;
+    }
+    ok = (fclose(file) == 0) && ok;
+  }
+  delete[] entries;
+
+  if(!ok){
+    printf("Failed to write the opening book to %s!\n", path);
+    return false;
+  }
+  printf("Wrote %d opening book entries to %s\n", count, path);
   return true;
 }
 
 /*
- * Properly deallocates all dynamic memory used for the game boards to avoid memory leaks. This function should be called before the program exits.
+ * Maps an opening book into memory. The book is left empty when the file is missing or was built for another board setup,
+ * in which case the AI always computes its digs live.
+ *
+ * @param book Book to load.
+ * @param path Book file path.
+ * @return True if the book was mapped.
  */
-void cleanup(){
-  for(int i = 0; i < krows; i++) {
-    delete[] userBoard[i]; 
-    delete[] aiBoard[i];
+bool loadOpeningBook(OpeningBook *book, const char *path){
+  book->data = NULL;
+  book->size = 0;
+  book->count = 0;
+
+  int fd = open(path, O_RDONLY);
+  if(fd < 0){
+    return false;
+  }
+  struct stat info;
+  void *data = MAP_FAILED;
+  if(fstat(fd, &info) == 0 && info.st_size >= 8 * (off_t)sizeof(unsigned int)){
+    data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if(data == MAP_FAILED){
+    return false;
   }
-  delete[] userBoard; 
-  delete[] aiBoard;
+
+  const unsigned int *header = (const unsigned int*)data;
+  size_t count = header[6];
+  bool valid = header[0] == kBookMagic && header[1] == 1 && header[2] == krows && header[3] == kcols && header[4] == chestAmounts
+    && (size_t)info.st_size == 8 * sizeof(unsigned int) + count * (sizeof(BookKey) + 1);
+  if(!valid){
+    munmap(data, info.st_size);
+    return false;
+  }
+
+  book->data = data;
+  book->size = info.st_size;
+  book->count = (int)count;
+  book->keys = (const BookKey*)(header + 8);
+  book->moves = (const unsigned char*)(book->keys + count);
+  return true;
 }
 
 /*
- * Main game loop that initializes the game, handles gameplay, and cleans up resources.
- * The loop continues until all treasures have been found on either the user's or AI's board.
+ * Unmaps an opening book loaded by loadOpeningBook().
+ *
+ * @param book Book to release.
  */
-int main(int argc, char** argv) {
-  bool placeChestChecker;
-  int digRow = 0;
-  int digCol = 0;
+void closeOpeningBook(OpeningBook *book){
+  if(book->data != NULL){
+    munmap(book->data, book->size);
+    book->data = NULL;
+  }
+}
+
+/*
+ * Chooses the AI's next dig on a board: a binary search of the opening book first, then bestDig() when the position is not in it.
+ *
+ * @param book Opening book, possibly empty.
+ * @param board Game board array being dug.
+ * @return Index (row * kcols + col) of the cell to dig.
+ */
+int chooseAiDig(const OpeningBook *book, int **board){
+  if(book->count > 0){
+    BookKey key;
+    makeBookKey(board, &key);
+    int low = 0;
+    int high = book->count - 1;
+    while(low <= high){
+      int mid = low + (high - low) / 2;
+      int order = compareBookKeys(&book->keys[mid], &key);
+      if(order == 0){
+        return book->moves[mid];
+      }
+      else if(order < 0){
+        low = mid + 1;
+      }
+      else{
+        high = mid - 1;
+      }
+    }
+  }
+  return bestDig(board);
+}
+
+/*
+ * Prompts a human player for an opponent (when more than one is left) and a location, then digs there.
+ *
+ * @param players State of every player.
+ * @param self The human player taking the turn.
+ * @return Index of the player whose board was dug.
+ */
+int humanTurn(PlayerStates *players, int self){
+  int target = -1;
+  int digRow = -1;
+  int digCol = -1;
   int status = -1;
 
-  // Setting up the 2D array ogBoard
-  for(int i = 0; i < krows; i++){
-    userBoard[i] = new int[kcols];
-    aiBoard[i] = new int[kcols];
+  if(countPlayersLeft(players) == 2){
+    target = chooseAiTarget(players, self);
+  }
+  while(target < 0 || target >= players->count || target == self || players->chestCellsLeft[target] == 0){
+    printf("\nPlayer %d, which player do you want to dig on? Enter a number between 1 and %d: ", self + 1, players->count);
+    status = scanf("%d", &target);
+    target = (status == 1) ? (target - 1) : -1;
+    if(target < 0 || target >= players->count || target == self || players->chestCellsLeft[target] == 0){
+      printf("The player you chose is invalid or already out! Try Again!\n");
+    }
+  }
+
+  status = -1;
+  while(status != 2 || digRow < 0 || digRow >= krows || digCol < 0 || digCol >= kcols){
+    printf("\n____________________Player %d Board (You)____________________\n", self + 1);
+    reveal(&players->rows[self * krows], krows, kcols);
+    printf("\n____________________Player %d Board (%s)____________________\n", target + 1, players->isHuman[target] ? "User" : "AI");
+    show(&players->rows[target * krows], krows, kcols);
+    printf("Please choose a row and a column location to dig: ");
+    status = scanf("%d %d", &digRow, &digCol);
+    if(status != 2 || digRow < 0 || digRow >= krows || digCol < 0 || digCol >= kcols){
+      printf("The value you input is invalid! Try Again!\n");
+    }
   }
 
-  initializeBoard(userBoard, krows, kcols);
-  initializeBoard(aiBoard, krows, kcols);
+  digOpponent(players, target, digRow, digCol, true);
+  return target;
+}
 
- // Attempt to place chests in different scenarios
-  printf("\n____________________Placing Chests (User) ____________________\n");
+/*
+ * Places one chest of every type on the board at random positions without printing, for simulated games.
+ *
+ * @param board Pointer to an empty game board array.
+ */
+void placeChestsRandomly(int **board){
   for(int i = 0; i < chestAmounts; i++){
-    printf("You have %d chests to place!\n\n", (chestAmounts - i));
-    reveal(userBoard, krows, kcols);
-    userInput();
+    int chestType = 11 + i;
+    while(!placeChest(board, rand() % krows, rand() % kcols, chestType, rand() % 2)){
+      // Retry until the chest fits
+    }
   }
-  printf("\n____________________Placing Chests (AI) ____________________\n");
-  for(int i = 0; i < chestAmounts; i++){
-    aiInput();
-  }
-
-  while(!gameEnd(userBoard) && !gameEnd(aiBoard)){
-    while(status != 2 || digRow < 0|| digRow > krows || digCol < 0 || digCol > kcols){
-      printf("\n____________________User Board____________________\n");
-      reveal(userBoard, krows, kcols);
-      printf("\n_____________________AI Board_____________________\n");
-      show(aiBoard, krows, kcols);
-      printf("Please choose a row and a column location to dig: ");
-      status = scanf("%d %d", &digRow, &digCol);
-      if(status != 2 || digRow < 0|| digRow > krows || digCol < 0 || digCol > kcols){
-        printf("The value you input is invalid! Try Again!\n");
+}
+
+/*
+ * Run-length encodes a column as (count, value) byte pairs. Gives up as soon as the output would not be smaller than the input.
+ *
+ * @param data Raw column bytes.
+ * @param size Number of raw bytes.
+ * @param out Destination buffer holding at least size bytes.
+ * @return Number of encoded bytes, or size if encoding does not pay off.
+ */
+unsigned int runLengthEncode(const unsigned char *data, unsigned int size, unsigned char *out){
+  unsigned int written = 0;
+  unsigned int i = 0;
+  while(i < size){
+    unsigned char value = data[i];
+    unsigned long long pattern = value * 0x0101010101010101ULL;
+    unsigned int run = 1;
+    // Extend long runs a word at a time, then finish byte by byte
+    while(run + 8 <= 255 && i + run + 8 <= size){
+      unsigned long long word;
+      memcpy(&word, data + i + run, 8);
+      if(word != pattern){
+        break;
+      }
+      run += 8;
+    }
+    while(i + run < size && run < 255 && data[i + run] == value){
+      run++;
+    }
+    if(written + 2 >= size){
+      return size;
+    }
+    out[written++] = (unsigned char)run;
+    out[written++] = value;
+    i += run;
+  }
+  return written;
+}
+
+/*
+ * Writes one column block as a {rawBytes, storedBytes} header followed by the stored bytes.
+ * The block is stored run-length encoded when compression is on and it helps, otherwise raw.
+ *
+ * @param file Output file.
+ * @param data Raw column bytes.
+ * @param rawBytes Number of raw bytes.
+ * @param compress Whether to try run-length encoding.
+ * @param scratch Buffer of at least rawBytes bytes used for encoding.
+ * @param encoded Bytes to run-length encode instead of data (e.g. a delta of it), or NULL to encode data itself.
+ * @return True if the block was written completely.
+ */
+bool writeColumn(FILE *file, const void *data, unsigned int rawBytes, bool compress, unsigned char *scratch, const void *encoded = NULL){
+  const void *stored = data;
+  unsigned int storedBytes = rawBytes;
+
+  if(compress){
+    const void *source = (encoded != NULL) ? encoded : data;
+    unsigned int packed = runLengthEncode((const unsigned char*)source, rawBytes, scratch);
+    if(packed < rawBytes){
+      stored = scratch;
+      storedBytes = packed;
+    }
+  }
+
+  unsigned int header[2] = {rawBytes, storedBytes};
+  if(fwrite(header, sizeof(header), 1, file) != 1){
+    return false;
+  }
+  return storedBytes == 0 || fwrite(stored, 1, storedBytes, file) == storedBytes;
+}
+
+/*
+ * Allocates the column arrays of a trajectory chunk.
+ *
+ * @param chunk Chunk to set up.
+ */
+void allocateTrajectoryChunk(TrajectoryChunk *chunk){
+  chunk->rows = 0;
+  chunk->gameId = new unsigned int[kExportChunkRows];
+  chunk->player = new unsigned char[kExportChunkRows];
+  chunk->turn = new unsigned short[kExportChunkRows];
+  chunk->boardState = new char[kExportChunkRows * kCells];
+  chunk->digRow = new unsigned char[kExportChunkRows];
+  chunk->digCol = new unsigned char[kExportChunkRows];
+  chunk->hit = new unsigned char[kExportChunkRows];
+  chunk->outcome = new unsigned char[kExportChunkRows];
+}
+
+/*
+ * Frees the column arrays of a trajectory chunk.
+ *
+ * @param chunk Chunk to release.
+ */
+void freeTrajectoryChunk(TrajectoryChunk *chunk){
+  delete[] chunk->gameId;
+  delete[] chunk->player;
+  delete[] chunk->turn;
+  delete[] chunk->boardState;
+  delete[] chunk->digRow;
+  delete[] chunk->digCol;
+  delete[] chunk->hit;
+  delete[] chunk->outcome;
+}
+
+/*
+ * Writes a full chunk to disk: a {rows, columns} header followed by one block per column.
+ * When compressed, the board column is XOR-ed with the row two back (the same board one turn earlier) before encoding,
+ * which turns almost every snapshot into zeros; the first two rows of the chunk are kept as they are.
+ * Runs on the writer's background thread while the simulation fills the other chunk.
+ *
+ * @param writer Writer owning the file and the chunk.
+ * @param index Index of the chunk to write.
+ */
+void writeTrajectoryChunk(TrajectoryWriter *writer, int index){
+  TrajectoryChunk *chunk = &writer->chunks[index];
+  FILE *file = writer->file;
+  bool compress = writer->compress;
+  unsigned char *scratch = writer->scratch;
+  unsigned int rows = chunk->rows;
+  unsigned int header[2] = {rows, kExportColumns};
+  const char *boardDelta = NULL;
+
+  if(compress){
+    const char *board = chunk->boardState;
+    char *delta = writer->delta;
+    unsigned int boardBytes = rows * kCells;
+    const unsigned int lag = 2 * kCells;
+    memcpy(delta, board, (boardBytes < lag) ? boardBytes : lag);
+    unsigned int i = lag;
+    // XOR a word at a time; lag is a multiple of 8 so words line up with the previous snapshot
+    for(; i + 8 <= boardBytes; i += 8){
+      unsigned long long now, before;
+      memcpy(&now, board + i, 8);
+      memcpy(&before, board + i - lag, 8);
+      now ^= before;
+      memcpy(delta + i, &now, 8);
+    }
+    for(; i < boardBytes; i++){
+      delta[i] = board[i] ^ board[i - lag];
+    }
+    boardDelta = delta;
+  }
+
+  bool ok = fwrite(header, sizeof(header), 1, file) == 1
+    && writeColumn(file, chunk->gameId, rows * sizeof(unsigned int), compress, scratch)
+    && writeColumn(file, chunk->player, rows, compress, scratch)
+    && writeColumn(file, chunk->turn, rows * sizeof(unsigned short), compress, scratch)
+    && writeColumn(file, chunk->boardState, rows * kCells, compress, scratch, boardDelta)
+    && writeColumn(file, chunk->digRow, rows, compress, scratch)
+    && writeColumn(file, chunk->digCol, rows, compress, scratch)
+    && writeColumn(file, chunk->hit, rows, compress, scratch)
+    && writeColumn(file, chunk->outcome, rows, compress, scratch);
+  if(!ok){
+    writer->failed = true;
+  }
+}
+
+/*
+ * Hands the active chunk to the background thread and switches to the other one.
+ * Waits for the previous write first, so at most one chunk is in flight.
+ *
+ * @param writer Writer whose active chunk should be flushed.
+ */
+void swapTrajectoryChunk(TrajectoryWriter *writer){
+  if(writer->flusher.joinable()){
+    writer->flusher.join();
+  }
+  writer->flusher = std::thread(writeTrajectoryChunk, writer, writer->active);
+  writer->active ^= 1;
+  writer->chunks[writer->active].rows = 0;
+}
+
+/*
+ * Opens a trajectory file and writes its header: magic "THTR", format version, board rows and board columns.
+ *
+ * @param writer Writer to initialize.
+ * @param path Output file path.
+ * @param compress Whether column blocks should be run-length encoded.
+ * @return True if the file was opened, false otherwise.
+ */
+bool openTrajectoryWriter(TrajectoryWriter *writer, const char *path, bool compress){
+  writer->file = fopen(path, "wb");
+  if(writer->file == NULL){
+    return false;
+  }
+  unsigned int header[4] = {0x52544854, 1, krows, kcols}; // "THTR" little-endian
+  if(fwrite(header, sizeof(header), 1, writer->file) != 1){
+    fclose(writer->file);
+    return false;
+  }
+  writer->compress = compress;
+  writer->failed = false;
+  writer->active = 0;
+  writer->scratch = new unsigned char[kExportChunkRows * kCells];
+  writer->delta = new char[kExportChunkRows * kCells];
+  allocateTrajectoryChunk(&writer->chunks[0]);
+  allocateTrajectoryChunk(&writer->chunks[1]);
+  return true;
+}
+
+/*
+ * Flushes any remaining rows, waits for the background write and releases the writer.
+ *
+ * @param writer Writer to close.
+ * @return True if every chunk was written successfully.
+ */
+bool closeTrajectoryWriter(TrajectoryWriter *writer){
+  if(writer->chunks[writer->active].rows > 0){
+    swapTrajectoryChunk(writer);
+  }
+  if(writer->flusher.joinable()){
+    writer->flusher.join();
+  }
+  bool ok = !writer->failed && fclose(writer->file) == 0;
+  freeTrajectoryChunk(&writer->chunks[0]);
+  freeTrajectoryChunk(&writer->chunks[1]);
+  delete[] writer->scratch;
+  delete[] writer->delta;
+  return ok;
+}
+
+/*
+ * Plays one silent AI-vs-AI game and appends every turn to the writer's active chunk.
+ * Each row holds the target board as show() would render it before the dig, the dig, whether it hit,
+ * and whether the digging player went on to win. Players dig each undug cell at most once.
+ *
+ * @param writer Writer receiving the rows.
+ * @param boards The two game boards, reused between games.
+ * @param gameId Identifier stored with every row of this game.
+ */
+void simulateGame(TrajectoryWriter *writer, int **boards[2], unsigned int gameId){
+  int chestsFound[2][5] = {{0}};
+  int chestCellsLeft[2] = {0, 0};
+  int digOrder[2][kCells];
+  char view[2][kCells];
+
+  for(int p = 0; p < 2; p++){
+    initializeBoard(boards[p], krows, kcols);
+    placeChestsRandomly(boards[p]);
+    for(int i = 0; i < chestAmounts; i++){
+      chestCellsLeft[p] += 5 - i;
+    }
+    // Shuffle the cells this player will dig in
+    for(int i = 0; i < kCells; i++){
+      digOrder[p][i] = i;
+      view[p][i] = '-';
+    }
+    for(int i = kCells - 1; i > 0; i--){
+      int j = rand() % (i + 1);
+      int swap = digOrder[p][i];
+      digOrder[p][i] = digOrder[p][j];
+      digOrder[p][j] = swap;
+    }
+  }
+
+  // A game never lasts longer than both players digging every cell
+  if(writer->chunks[writer->active].rows + 2 * kCells > kExportChunkRows){
+    swapTrajectoryChunk(writer);
+  }
+  TrajectoryChunk *chunk = &writer->chunks[writer->active];
+  int firstRow = chunk->rows;
+  int player = 0;
+  int winner = 0;
+
+  for(int turn = 0; ; turn++){
+    int target = 1 - player;
+    int cell = digOrder[player][turn / 2];
+    int digRow = cell / kcols;
+    int digCol = cell % kcols;
+    int row = chunk->rows++;
+
+    chunk->gameId[row] = gameId;
+    chunk->player[row] = (unsigned char)player;
+    chunk->turn[row] = (unsigned short)turn;
+    memcpy(&chunk->boardState[row * kCells], view[target], kCells);
+    chunk->digRow[row] = (unsigned char)digRow;
+    chunk->digCol[row] = (unsigned char)digCol;
+
+    bool hit = resolveDig(boards[target], digRow, digCol, chestsFound[player]) > kDigMiss;
+    chunk->hit[row] = hit;
+    view[target][cell] = showCell(boards[target][digRow][digCol]);
+    if(hit && --chestCellsLeft[target] == 0){
+      winner = player;
+      break;
+    }
+    player = target;
+  }
+
+  // Fill in the final outcome now that the winner is known
+  for(int row = firstRow; row < chunk->rows; row++){
+    chunk->outcome[row] = (chunk->player[row] == winner);
+  }
+}
+
+/*
+ * Simulates AI-vs-AI games and streams every turn to a chunked columnar trajectory file for ML training.
+ *
+ * @param path Output file path.
+ * @param games Number of games to simulate.
+ * @param compress Whether column blocks should be run-length encoded.
+ * @return True if the whole file was written successfully.
+ */
+bool exportTrajectories(const char *path, int games, bool compress){
+  TrajectoryWriter writer;
+  if(!openTrajectoryWriter(&writer, path, compress)){
+    printf("Could not open %s for writing!\n", path);
+    return false;
+  }
+
+  int **boards[2];
+  for(int p = 0; p < 2; p++){
+    boards[p] = new int*[krows];
+    for(int i = 0; i < krows; i++){
+      boards[p][i] = new int[kcols];
+    }
+  }
+
+  for(int game = 0; game < games; game++){
+    simulateGame(&writer, boards, game);
+  }
+
+  for(int p = 0; p < 2; p++){
+    for(int i = 0; i < krows; i++){
+      delete[] boards[p][i];
+    }
+    delete[] boards[p];
+  }
+
+  if(!closeTrajectoryWriter(&writer)){
+    printf("Failed to write trajectories to %s!\n", path);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Main game loop that initializes the game, handles gameplay, and cleans up resources.
+ * Players take turns in order, each digging on a chosen opponent's board. A player whose treasures have all been found is out,
+ * and the loop continues until only one player is left.
+ */
+int main(int argc, char** argv) {
+  srand(time(NULL));
+
+  // Usage: treasureHunt --export <file> <games> [--compress]
+  if(argc >= 4 && strcmp(argv[1], "--export") == 0){
+    bool compress = (argc >= 5 && strcmp(argv[4], "--compress") == 0);
+    return exportTrajectories(argv[2], atoi(argv[3]), compress) ? 0 : 1;
+  }
+
+  // Usage: treasureHunt --generate-book <file> <depth>
+  if(argc >= 4 && strcmp(argv[1], "--generate-book") == 0){
+    return generateOpeningBook(argv[2], atoi(argv[3])) ? 0 : 1;
+  }
+
+  // Usage: treasureHunt [--players <n>] [--humans <h>] [--book <file>], defaulting to one user against one AI
+  int playerCount = 2;
+  int humanCount = 1;
+  const char *bookPath = "openingBook.bin";
+  for(int i = 1; i + 1 < argc; i += 2){
+    if(strcmp(argv[i], "--players") == 0){
+      playerCount = atoi(argv[i + 1]);
+    }
+    else if(strcmp(argv[i], "--humans") == 0){
+      humanCount = atoi(argv[i + 1]);
+    }
+    else if(strcmp(argv[i], "--book") == 0){
+      bookPath = argv[i + 1];
+    }
+  }
+  if(playerCount < 2 || humanCount < 0 || humanCount > playerCount){
+    printf("You need at least 2 players and no more humans than players!\n");
+    return 1;
+  }
+
+  OpeningBook book;
+  loadOpeningBook(&book, bookPath);
+  PlayerStates players;
+  allocatePlayers(&players, playerCount, humanCount);
+  bool announce = (humanCount > 0);
+
+  // Attempt to place chests in different scenarios
+  for(int p = 0; p < playerCount; p++){
+    int **board = &players.rows[p * krows];
+    if(players.isHuman[p]){
+      printf("\n____________________Placing Chests (Player %d, User) ____________________\n", p + 1);
+      for(int i = 0; i < chestAmounts; i++){
+        printf("You have %d chests to place!\n\n", (chestAmounts - i));
+        reveal(board, krows, kcols);
+        userInput(board);
+      }
+    }
+    else{
+      if(announce){
+        printf("\n____________________Placing Chests (Player %d, AI) ____________________\n", p + 1);
+        for(int i = 0; i < chestAmounts; i++){
+          aiInput(board);
+        }
+      }
+      else{
+        placeChestsRandomly(board);
       }
     }
-    dig(aiBoard, digRow, digCol, userChestsFound); // User digs on AI board
-    if(!gameEnd(aiBoard)){
-      digRow = rand() % krows;
-      digCol = rand() % kcols;
-      dig(userBoard, digRow, digCol, aiChestsFound); // AI digs on user board
-      status = -1;
+    players.chestCellsLeft[p] = countChestCells(board);
+  }
+
+  int playersLeft = countPlayersLeft(&players);
+  int current = 0;
+  while(playersLeft > 1){
+    if(players.chestCellsLeft[current] > 0){
+      int target;
+      bool eliminated;
+      if(players.isHuman[current]){
+        target = humanTurn(&players, current);
+        eliminated = (players.chestCellsLeft[target] == 0);
+      }
+      else{
+        target = chooseAiTarget(&players, current);
+        int cell = chooseAiDig(&book, &players.rows[target * krows]);
+        eliminated = digOpponent(&players, target, cell / kcols, cell % kcols, announce);
+      }
+      if(eliminated){
+        playersLeft = countPlayersLeft(&players);
+        if(playersLeft > 1){
+          printf("All treasures of player %d found! Player %d is out!\n", target + 1, target + 1);
+        }
+      }
     }
+    current = (current + 1) % playerCount;
   }
 
-  if(gameEnd(userBoard)){
-    printf("All treasures found! AI wins!\n");
+  int winner = 0;
+  while(players.chestCellsLeft[winner] == 0){
+    winner++;
+  }
+  if(playerCount == 2){
+    printf("All treasures found! %s wins!\n", players.isHuman[winner] ? "User" : "AI");
   }
   else{
-    printf("All treasures found! User wins!\n");
+    printf("All treasures found! Player %d (%s) wins!\n", winner + 1, players.isHuman[winner] ? "User" : "AI");
   }
-  
+
   // Deallocates Memory
-  cleanup();
+  freePlayers(&players);
+  closeOpeningBook(&book);
   return 0;
 }
 